@@ -0,0 +1,152 @@
+// Round-trip check for audio payload encryption.
+//
+// Usage: ./build/audio_roundtrip [video]
+//
+// Encrypts the audio of a video (default video/test1.mp4) into an .mp4 and a
+// .ts with encode_video_encrypt_audio, then checks that:
+//   - every audio packet's payload differs from the source,
+//   - the .ts still demuxes as ADTS, with the headers in clear,
+//   - the two files do not share a keystream, even with the same seed,
+//   - decrypt_audio_remux restores every audio packet byte-for-byte,
+//   - a wrong seed does not.
+//
+// Exits non-zero if a check fails.
+
+#include "codec/compress.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using Packets = std::vector<std::vector<uint8_t>>;
+
+static bool check(bool ok, const char *what) {
+    printf("  [%s] %s\n", ok ? "ok" : "FAIL", what);
+    return ok;
+}
+
+// Reads every packet of the first audio stream. Returns false if the file
+// does not open or has no audio.
+static bool read_audio_packets(const std::string &path, Packets &packets, AVCodecParameters **par = nullptr) {
+    AVFormatContext *fmtCtx = nullptr;
+    if (avformat_open_input(&fmtCtx, path.c_str(), nullptr, nullptr) < 0)
+        return false;
+    int audioIndex = -1;
+    if (avformat_find_stream_info(fmtCtx, nullptr) >= 0)
+        audioIndex = find_audio_stream(fmtCtx);
+    if (audioIndex >= 0) {
+        if (par) {
+            *par = avcodec_parameters_alloc();
+            avcodec_parameters_copy(*par, fmtCtx->streams[audioIndex]->codecpar);
+        }
+        AVPacket *pkt = av_packet_alloc();
+        while (pkt && av_read_frame(fmtCtx, pkt) >= 0) {
+            if (pkt->stream_index == audioIndex)
+                packets.emplace_back(pkt->data, pkt->data + pkt->size);
+            av_packet_unref(pkt);
+        }
+        av_packet_free(&pkt);
+    }
+    avformat_close_input(&fmtCtx);
+    return audioIndex >= 0;
+}
+
+static bool is_adts(const std::vector<uint8_t> &p) {
+    return p.size() >= 7 && p[0] == 0xFF && (p[1] & 0xF6) == 0xF0;
+}
+
+// Payload of an ADTS frame, without its 7- or 9-byte header.
+static std::vector<uint8_t> adts_payload(const std::vector<uint8_t> &p) {
+    size_t header = (p[1] & 0x01) ? 7 : 9;
+    return std::vector<uint8_t>(p.begin() + std::min(header, p.size()), p.end());
+}
+
+static int count_equal(const Packets &a, const Packets &b) {
+    int equal = 0;
+    for (size_t i = 0; i < std::min(a.size(), b.size()); i++)
+        if (!a[i].empty() && a[i] == b[i]) equal++;
+    return equal;
+}
+
+int main(int argc, char *argv[]) {
+    std::string video = argc > 1 ? argv[1] : "video/test1.mp4";
+    const std::string seed = "audioroundtripkey";
+    const std::string encMp4 = "video/output/audio_roundtrip_enc.mp4";
+    const std::string encTs = "video/output/audio_roundtrip_enc.ts";
+    const std::string decMp4 = "video/output/audio_roundtrip_dec.mp4";
+    const std::string decTs = "video/output/audio_roundtrip_dec.ts";
+    const std::string wrongMp4 = "video/output/audio_roundtrip_wrong.mp4";
+    const std::string tsNonce = encTs + AUDIO_NONCE_SIDECAR;
+    for (const std::string &path : {encMp4, encTs, decMp4, decTs, wrongMp4, tsNonce})
+        fs::remove(path);
+    fs::create_directories("video/output");
+
+    Packets source;
+    AVCodecParameters *par = nullptr;
+    if (!read_audio_packets(video, source, &par) || source.empty()) {
+        printf("%s has no audio\n", video.c_str());
+        return EXIT_FAILURE;
+    }
+    bool aac = par->codec_id == AV_CODEC_ID_AAC;
+    printf("%s: %zu %s audio packets\n", video.c_str(), source.size(), avcodec_get_name(par->codec_id));
+    avcodec_parameters_free(&par);
+    if (!aac) {
+        printf("audio encryption only supports AAC\n");
+        return EXIT_FAILURE;
+    }
+
+    bool ok = true;
+
+    printf("encrypt to .mp4\n");
+    Packets mp4;
+    ok &= check(encode_video_encrypt_audio(video.c_str(), encMp4.c_str(), seed.c_str()) == 0,
+                "encode_video_encrypt_audio succeeds");
+    ok &= check(read_audio_packets(encMp4, mp4), "output has an audio stream");
+    ok &= check(mp4.size() == source.size(), "audio packet count unchanged");
+    ok &= check(count_equal(mp4, source) == 0, "every audio packet differs from the source");
+    ok &= check(!fs::exists(encMp4 + AUDIO_NONCE_SIDECAR), "nonce kept in the mp4 tag, no nonce file");
+
+    printf("encrypt to .ts\n");
+    Packets ts;
+    ok &= check(encode_video_encrypt_audio(video.c_str(), encTs.c_str(), seed.c_str()) == 0,
+                "encode_video_encrypt_audio succeeds");
+    ok &= check(read_audio_packets(encTs, ts), "output demuxes with an audio stream");
+    ok &= check(ts.size() == source.size(), "audio packet count unchanged");
+    bool allAdts = !ts.empty();
+    for (const std::vector<uint8_t> &p : ts) allAdts &= is_adts(p);
+    ok &= check(allAdts, "every packet starts with a clear ADTS header");
+    ok &= check(fs::exists(tsNonce), "nonce written to the .audio_nonce file");
+    Packets tsPayloads;
+    for (const std::vector<uint8_t> &p : ts) tsPayloads.push_back(adts_payload(p));
+    ok &= check(count_equal(tsPayloads, source) == 0, "every audio payload differs from the source");
+    ok &= check(count_equal(tsPayloads, mp4) == 0, "same seed, different file: no shared keystream");
+
+    printf("decrypt\n");
+    Packets decrypted;
+    ok &= check(decrypt_audio_remux(encMp4.c_str(), decMp4.c_str(), seed.c_str()) == 0,
+                "decrypt_audio_remux on the .mp4 succeeds");
+    ok &= check(read_audio_packets(decMp4, decrypted) && decrypted == source,
+                "every .mp4 audio packet matches the source byte-for-byte");
+
+    Packets decryptedTs;
+    ok &= check(decrypt_audio_remux(encTs.c_str(), decTs.c_str(), seed.c_str()) == 0,
+                "decrypt_audio_remux on the .ts succeeds");
+    bool tsMatches = read_audio_packets(decTs, decryptedTs) && decryptedTs.size() == source.size();
+    for (size_t i = 0; tsMatches && i < source.size(); i++)
+        tsMatches = is_adts(decryptedTs[i]) && adts_payload(decryptedTs[i]) == source[i];
+    ok &= check(tsMatches, "every .ts audio payload matches the source byte-for-byte");
+
+    Packets wrong;
+    decrypt_audio_remux(encMp4.c_str(), wrongMp4.c_str(), "notthekey");
+    read_audio_packets(wrongMp4, wrong);
+    ok &= check(count_equal(wrong, source) == 0, "a wrong seed does not restore the audio");
+
+    for (const std::string &path : {encMp4, encTs, decMp4, decTs, wrongMp4, tsNonce})
+        fs::remove(path);
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,203 @@
+// Stand-in service client for the job pool.
+//
+// Usage: ./build/job_pool_client [jobs] [workers] [queue] [video]
+//
+// Part 1 submits many synthetic jobs whose work mimics a process_frames loop
+// (poll for cancellation, do a frame's worth of work, report progress), cancels
+// every fifth one, and checks, from a monitor thread sampling the pool, that
+// concurrency and queue depth stay within bounds. A job whose progress callback
+// throws must end up cancelled.
+//
+// Part 2 runs the real entry points through media_jobs on a video (default
+// video/test1.mp4): one encode to completion, then an encode, a Scheme1 encrypt
+// and a Scheme1 decrypt that are each cancelled partway through and must return
+// JOB_CANCELLED without leaving their output file behind.
+//
+// Exits non-zero if a check fails.
+
+#include "jobs/media_jobs.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Cancel once the job has reported `frames` frames or `maxWait` has passed.
+static void cancel_partway(const Jobs::JobHandle &job, int64_t frames, std::chrono::milliseconds maxWait) {
+    auto deadline = std::chrono::steady_clock::now() + maxWait;
+    while (job->progress().framesDone < frames && std::chrono::steady_clock::now() < deadline &&
+           job->result().wait_for(std::chrono::milliseconds(5)) != std::future_status::ready) {}
+    job->cancel();
+}
+
+static bool check(bool ok, const char *what) {
+    printf("  [%s] %s\n", ok ? "ok" : "FAIL", what);
+    return ok;
+}
+
+static bool run_synthetic(int numJobs, size_t workers, size_t maxQueued) {
+    const int framesPerJob = 50;
+    std::atomic<int64_t> callbacks{0};
+    std::atomic<size_t> peakQueued{0};
+    std::atomic<size_t> peakRunning{0};
+    int rejected = 0;
+    int throwingResult = 0;
+
+    auto work = [&](JobControl &control) {
+        for (int f = 0; f < framesPerJob; f++) {
+            if (control.is_cancelled()) return JOB_CANCELLED;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            control.report(f + 1, framesPerJob);
+        }
+        return 0;
+    };
+    auto onProgress = [&](const Jobs::Progress &) { callbacks++; };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Jobs::JobHandle> jobs;
+    {
+        Jobs::JobPool pool(workers, maxQueued);
+
+        // Sample the pool independently of the submitting thread.
+        std::atomic<bool> monitoring{true};
+        std::thread monitor([&] {
+            while (monitoring) {
+                peakQueued = std::max(peakQueued.load(), pool.queued());
+                peakRunning = std::max(peakRunning.load(), pool.running());
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+
+        // Non-blocking admission first: once the queue fills, try_submit must refuse.
+        for (size_t i = 0; i < workers + maxQueued * 2; i++) {
+            Jobs::JobHandle job = pool.try_submit(work, onProgress);
+            if (job) jobs.push_back(job);
+            else rejected++;
+        }
+
+        // Then blocking admission: submit() waits for room instead of growing the queue.
+        while ((int)jobs.size() < numJobs) {
+            jobs.push_back(pool.submit(work, onProgress));
+            if (jobs.size() % 5 == 0) jobs.back()->cancel();
+        }
+        // Cancel one that is most likely mid-run.
+        if (jobs.size() > maxQueued)
+            jobs[jobs.size() - maxQueued - 1]->cancel();
+
+        Jobs::JobHandle last = jobs.back();
+        while (last->result().wait_for(std::chrono::milliseconds(20)) != std::future_status::ready) {
+            Jobs::Progress p = last->progress();
+            printf("queued %zu running %zu | last job %lld/%lld frames, %.0f fps, eta %.2fs\n",
+                   pool.queued(), pool.running(), (long long)p.framesDone, (long long)p.totalFrames,
+                   p.framesPerSecond, p.etaSeconds);
+        }
+        for (const Jobs::JobHandle &job : jobs) job->wait();
+        monitoring = false;
+        monitor.join();
+
+        // A throwing progress callback must not escape into the work loop.
+        Jobs::JobHandle throwing = pool.submit(work, [](const Jobs::Progress &p) {
+            if (p.framesDone == 3) throw std::runtime_error("callback failure");
+        });
+        throwingResult = throwing->wait();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int done = 0, cancelled = 0, failed = 0;
+    for (const Jobs::JobHandle &job : jobs) {
+        int ret = job->wait();
+        if (ret == 0) done++;
+        else if (ret == JOB_CANCELLED) cancelled++;
+        else failed++;
+    }
+
+    printf("synthetic: %zu jobs, %d done, %d cancelled, %d failed; %d rejected by try_submit\n",
+           jobs.size(), done, cancelled, failed, rejected);
+    printf("peak running %zu (workers %zu), peak queued %zu (limit %zu)\n",
+           peakRunning.load(), workers, peakQueued.load(), maxQueued);
+    printf("%lld progress callbacks, %.2fs, %.0f frames/s\n", (long long)callbacks.load(), elapsed,
+           done * framesPerJob / elapsed);
+
+    bool ok = true;
+    ok &= check(failed == 0, "no synthetic job failed");
+    ok &= check(cancelled > 0, "cancelled jobs return JOB_CANCELLED");
+    ok &= check(rejected > 0, "try_submit refuses when the queue is full");
+    ok &= check(peakRunning.load() <= workers, "running jobs never exceed workers");
+    ok &= check(peakQueued.load() <= maxQueued, "queue depth never exceeds its limit");
+    ok &= check(done + cancelled == (int)jobs.size(), "every job finished");
+    ok &= check(throwingResult == JOB_CANCELLED, "a throwing progress callback cancels its job");
+    return ok;
+}
+
+static bool run_media(const std::string &video) {
+    if (!fs::exists(video)) {
+        printf("media: %s not found\n", video.c_str());
+        return false;
+    }
+    const std::string encoded = "video/output/job_client_encoded.mp4";
+    const std::string cancelledEncode = "video/output/job_client_cancelled.mp4";
+    const std::string encrypted = "video/output/job_client_encrypted.mp4";
+    const std::string decrypted = "video/output/job_client_decrypted.mp4";
+    for (const std::string &path : {encoded, cancelledEncode, encrypted, decrypted})
+        fs::remove(path);
+
+    auto onProgress = [](const Jobs::Progress &p) {
+        if (p.framesDone % 25 == 0)
+            printf("  %lld/%lld frames, %.1f fps, eta %.1fs\n", (long long)p.framesDone,
+                   (long long)p.totalFrames, p.framesPerSecond, p.etaSeconds);
+    };
+
+    bool ok = true;
+    Jobs::JobPool pool(2, 2);
+
+    printf("media: encode %s to completion\n", video.c_str());
+    Jobs::JobHandle full = Jobs::submit_encode(pool, video, encoded, onProgress);
+    ok &= check(full->wait() == 0 && fs::exists(encoded), "submit_encode finishes and writes its output");
+
+    printf("media: encode cancelled after 10 frames\n");
+    Jobs::JobHandle enc = Jobs::submit_encode(pool, video, cancelledEncode, onProgress);
+    cancel_partway(enc, 10, std::chrono::seconds(30));
+    ok &= check(enc->wait() == JOB_CANCELLED, "process_frames returns JOB_CANCELLED");
+    ok &= check(!fs::exists(cancelledEncode), "cancelled encode leaves no output");
+
+    // Scheme1 spends its first seconds inside ffmpeg extracting frames, so a
+    // short delay cancels during the subprocess; the frame count covers the loop.
+    printf("media: Scheme1 encrypt cancelled during frame extraction\n");
+    Jobs::JobHandle encr = Jobs::submit_encrypt(pool, encoded, encrypted, "jobclientkey", Encryption::Scheme::Scheme1);
+    cancel_partway(encr, 1, std::chrono::milliseconds(300));
+    auto t0 = std::chrono::steady_clock::now();
+    int encrRet = encr->wait();
+    double stopSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    ok &= check(encrRet == JOB_CANCELLED, "Scheme1 encrypt returns JOB_CANCELLED");
+    ok &= check(stopSeconds < 2.0, "cancelled encrypt releases its worker promptly");
+    ok &= check(!fs::exists(encrypted), "cancelled encrypt leaves no output");
+
+    printf("media: Scheme1 decrypt cancelled after 5 frames\n");
+    Jobs::JobHandle decr = Jobs::submit_decrypt(pool, encoded, decrypted, "jobclientkey", Encryption::Scheme::Scheme1, onProgress);
+    cancel_partway(decr, 5, std::chrono::seconds(60));
+    ok &= check(decr->wait() == JOB_CANCELLED, "Scheme1 decrypt returns JOB_CANCELLED");
+    ok &= check(!fs::exists(decrypted), "cancelled decrypt leaves no output");
+
+    fs::remove(encoded);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int numJobs = argc > 1 ? std::atoi(argv[1]) : 64;
+    size_t workers = std::max(1, argc > 2 ? std::atoi(argv[2]) : 4);
+    // JobPool clamps both limits to at least 1; mirror that for the checks.
+    size_t maxQueued = std::max(1, argc > 3 ? std::atoi(argv[3]) : 8);
+    std::string video = argc > 4 ? argv[4] : "video/test1.mp4";
+
+    bool ok = run_synthetic(numJobs, workers, maxQueued);
+    ok &= run_media(video);
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,68 @@
+// Benchmark: Scheme1 per-frame cost versus ROI coverage.
+//
+// Usage: ./build/scheme1_roi_bench [width height] [iterations]
+//
+// A random frame is encrypted with a tile mask covering an increasing share of
+// the frame; 100% is compared against the full-frame encrypt_image.
+//
+// This times only the in-memory transform step (encrypt_image_roi, including
+// its full-frame clone). encrypt_roi also writes every frame to PNG, reads it
+// back and re-encodes the video with x264, and that cost does not shrink with
+// ROI coverage, so end-to-end savings are smaller than these numbers suggest.
+
+#include "encryption_schemes/scheme1/scheme_1.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+static double time_ms(int iterations, const std::function<void()> &fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int width = argc > 2 ? std::atoi(argv[1]) : 3840;
+    int height = argc > 2 ? std::atoi(argv[2]) : 2160;
+    int iterations = argc > 3 ? std::atoi(argv[3]) : 5;
+    const int tileSize = 64;
+    const std::string key = "benchmarkkey1234";
+
+    cv::Mat frame(height, width, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+    double frameMp = width * static_cast<double>(height) / 1e6;
+
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesY = (height + tileSize - 1) / tileSize;
+    std::vector<int> order(tilesX * tilesY);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    printf("frame %dx%d (%.2f MP), tile %d, %d iterations\n", width, height, frameMp, tileSize, iterations);
+    printf("%9s %8s %12s %14s %14s\n", "coverage", "rects", "ms/frame", "ms/frame-MP", "ms/ROI-MP");
+
+    for (int pct : {0, 5, 10, 25, 50, 100}) {
+        std::vector<uchar> mask(order.size(), 0);
+        size_t marked = order.size() * pct / 100;
+        for (size_t i = 0; i < marked; i++) mask[order[i]] = 1;
+        std::vector<cv::Rect> rois = Scheme1::tile_mask_rois(frame.size(), tileSize, mask);
+
+        double roiMp = 0;
+        for (const cv::Rect &r : rois) roiMp += r.area() / 1e6;
+
+        double ms = time_ms(iterations, [&] { Scheme1::encrypt_image_roi(frame, key, rois); });
+        printf("%8d%% %8zu %12.2f %14.3f %14s\n", pct, rois.size(), ms, ms / frameMp,
+               roiMp > 0 ? std::to_string(ms / roiMp).c_str() : "-");
+    }
+
+    double full = time_ms(iterations, [&] { Scheme1::encrypt_image(frame, key); });
+    printf("%9s %8s %12.2f %14.3f %14.3f\n", "full", "-", full, full / frameMp, full / frameMp);
+    return 0;
+}
@@ -0,0 +1,238 @@
+#include "audio.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+extern "C" {
+  #include <libavutil/opt.h>
+}
+
+struct AudioCipher {
+    EVP_CIPHER_CTX* ctx;
+    unsigned char nonce[8];
+    bool adts;
+    uint64_t packetIndex;
+};
+
+// Length of the ADTS header at the start of the packet, or 0 if there is none.
+// Only called for streams known to be ADTS-framed, where the header is in clear.
+static int adts_header_length(const uint8_t* data, int size) {
+    if (size < 7 || data[0] != 0xFF || (data[1] & 0xF6) != 0xF0)
+        return 0;
+    // protection_absent == 0 means a 16-bit CRC follows the fixed header.
+    int len = (data[1] & 0x01) ? 7 : 9;
+    return len <= size ? len : 0;
+}
+
+// AAC without an AudioSpecificConfig in extradata is carried as ADTS (raw .aac,
+// MPEG-TS); MP4/MKV store raw access units and put the config in extradata.
+static bool stream_is_adts(const AVCodecParameters* par) {
+    return par->codec_id == AV_CODEC_ID_AAC && par->extradata_size == 0;
+}
+
+int find_audio_stream(AVFormatContext* inFmtCtx) {
+    for (unsigned i = 0; i < inFmtCtx->nb_streams; i++) {
+        if (inFmtCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+            return i;
+    }
+    return -1;
+}
+
+AVStream* add_audio_stream(AVFormatContext* inFmtCtx, int audioStreamIndex, AVFormatContext* outFmtCtx) {
+    AVStream* inStream = inFmtCtx->streams[audioStreamIndex];
+    AVStream* outStream = avformat_new_stream(outFmtCtx, nullptr);
+    if (!outStream) {
+        fprintf(stderr, "Failed allocating audio output stream\n");
+        return nullptr;
+    }
+    if (avcodec_parameters_copy(outStream->codecpar, inStream->codecpar) < 0) {
+        fprintf(stderr, "Failed to copy audio stream parameters\n");
+        return nullptr;
+    }
+    // Let the muxer pick the tag for its own container.
+    outStream->codecpar->codec_tag = 0;
+    outStream->time_base = inStream->time_base;
+    return outStream;
+}
+
+// Label for the key derivation; distinct from Scheme2's "<seed>_<index>" inputs.
+static const char AUDIO_KEY_LABEL[] = "selective_encryption/audio-ctr/v1";
+
+static void nonce_to_hex(const unsigned char nonce[8], char hex[17]) {
+    for (int i = 0; i < 8; i++)
+        snprintf(hex + 2 * i, 3, "%02x", nonce[i]);
+}
+
+static bool nonce_from_hex(const char* hex, unsigned char nonce[8]) {
+    if (!hex || strlen(hex) < 16) return false;
+    for (int i = 0; i < 8; i++) {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1) return false;
+        nonce[i] = (unsigned char)byte;
+    }
+    return true;
+}
+
+// Stores the nonce with the output: as a tag, and as a sidecar file for
+// containers that do not keep custom tags.
+static int store_nonce(AVFormatContext* outFmtCtx, AVStream* outStream, const unsigned char nonce[8]) {
+    char hex[17];
+    nonce_to_hex(nonce, hex);
+    av_dict_set(&outFmtCtx->metadata, AUDIO_NONCE_TAG, hex, 0);
+    av_dict_set(&outStream->metadata, AUDIO_NONCE_TAG, hex, 0);
+    // MP4/MOV only write custom keys with use_metadata_tags; Matroska keeps them as is.
+    bool keepsTags = av_opt_set(outFmtCtx, "movflags", "+use_metadata_tags", AV_OPT_SEARCH_CHILDREN) >= 0 ||
+                     strcmp(outFmtCtx->oformat->name, "matroska") == 0 ||
+                     strcmp(outFmtCtx->oformat->name, "webm") == 0;
+    if (keepsTags)
+        return 0;
+    std::string path = std::string(outFmtCtx->url) + AUDIO_NONCE_SIDECAR;
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f || fprintf(f, "%s\n", hex) < 0 || fclose(f) != 0) {
+        fprintf(stderr, "Could not write audio nonce file '%s'\n", path.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+// Reads the nonce stored by store_nonce from the input's tags or sidecar.
+static int load_nonce(AVFormatContext* inFmtCtx, AVStream* inStream, unsigned char nonce[8]) {
+    AVDictionaryEntry* tag = av_dict_get(inFmtCtx->metadata, AUDIO_NONCE_TAG, nullptr, 0);
+    if (!tag) tag = av_dict_get(inStream->metadata, AUDIO_NONCE_TAG, nullptr, 0);
+    if (tag && nonce_from_hex(tag->value, nonce))
+        return 0;
+    std::string path = std::string(inFmtCtx->url) + AUDIO_NONCE_SIDECAR;
+    char hex[32] = {0};
+    FILE* f = fopen(path.c_str(), "r");
+    bool ok = f && fgets(hex, sizeof(hex), f) && nonce_from_hex(hex, nonce);
+    if (f) fclose(f);
+    if (!ok) {
+        fprintf(stderr, "No audio nonce found: the '%s' tag or '%s' is required to decrypt the audio\n",
+                AUDIO_NONCE_TAG, path.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+int setup_audio_track(AVFormatContext* inFmtCtx, AVFormatContext* outFmtCtx,
+                      const char* seed, bool decrypting, AudioTrack* track) {
+    track->inIndex = find_audio_stream(inFmtCtx);
+    track->outStream = nullptr;
+    track->cipher = nullptr;
+    if (track->inIndex < 0)
+        return 0;
+    AVStream* inStream = inFmtCtx->streams[track->inIndex];
+    AVCodecParameters* par = inStream->codecpar;
+    if (seed && par->codec_id != AV_CODEC_ID_AAC) {
+        fprintf(stderr, "Audio encryption supports only AAC, not '%s': its frame headers would be "
+                "encrypted and the output could not be demuxed\n", avcodec_get_name(par->codec_id));
+        return AVERROR(ENOSYS);
+    }
+    if (avformat_query_codec(outFmtCtx->oformat, par->codec_id, FF_COMPLIANCE_NORMAL) != 1) {
+        fprintf(stderr, "Warning: output format '%s' cannot carry audio codec '%s', dropping audio\n",
+                outFmtCtx->oformat->name, avcodec_get_name(par->codec_id));
+        return 0;
+    }
+    track->outStream = add_audio_stream(inFmtCtx, track->inIndex, outFmtCtx);
+    if (!track->outStream)
+        return -1;
+    if (!seed)
+        return 0;
+
+    unsigned char nonce[8];
+    if (decrypting) {
+        if (load_nonce(inFmtCtx, inStream, nonce) < 0)
+            return -1;
+    } else {
+        if (RAND_bytes(nonce, sizeof(nonce)) != 1) {
+            fprintf(stderr, "Could not generate audio nonce\n");
+            return -1;
+        }
+        if (store_nonce(outFmtCtx, track->outStream, nonce) < 0)
+            return -1;
+    }
+    track->cipher = audio_cipher_create(seed, nonce, stream_is_adts(par));
+    return track->cipher ? 0 : -1;
+}
+
+AudioCipher* audio_cipher_create(const char* seed, const unsigned char nonce[8], bool adts) {
+    // key = sha256(label || 0 || seed || 0 || nonce)
+    std::string data = std::string(AUDIO_KEY_LABEL) + '\0' + seed + '\0' +
+                       std::string(reinterpret_cast<const char*>(nonce), 8);
+    unsigned char key[32];
+    if (!EVP_Digest(data.data(), data.size(), key, nullptr, EVP_sha256(), nullptr)) {
+        fprintf(stderr, "Failed to derive audio key\n");
+        return nullptr;
+    }
+
+    AudioCipher* cipher = (AudioCipher*)calloc(1, sizeof(AudioCipher));
+    if (!cipher) {
+        fprintf(stderr, "Could not allocate audio cipher\n");
+        return nullptr;
+    }
+    memcpy(cipher->nonce, nonce, 8);
+    cipher->adts = adts;
+    cipher->packetIndex = 0;
+    cipher->ctx = EVP_CIPHER_CTX_new();
+    if (!cipher->ctx || !EVP_EncryptInit_ex(cipher->ctx, EVP_aes_256_ctr(), nullptr, key, nullptr)) {
+        fprintf(stderr, "Could not initialise audio cipher\n");
+        audio_cipher_free(&cipher);
+        return nullptr;
+    }
+    return cipher;
+}
+
+void audio_cipher_free(AudioCipher** cipher) {
+    if (!cipher || !*cipher) return;
+    if ((*cipher)->ctx) EVP_CIPHER_CTX_free((*cipher)->ctx);
+    free(*cipher);
+    *cipher = nullptr;
+}
+
+int audio_cipher_apply(AudioCipher* cipher, AVPacket* pkt) {
+    int ret = av_packet_make_writable(pkt);
+    if (ret < 0) {
+        fprintf(stderr, "Could not make audio packet writable\n");
+        return ret;
+    }
+    // Counter block = nonce || big-endian (packet index << 32); blocks within the
+    // packet count up from there. Re-keying per packet keeps a bad packet local.
+    unsigned char iv[16];
+    memcpy(iv, cipher->nonce, 8);
+    uint64_t counter = cipher->packetIndex++ << 32;
+    for (int i = 0; i < 8; i++)
+        iv[15 - i] = (unsigned char)(counter >> (8 * i));
+    if (!EVP_EncryptInit_ex(cipher->ctx, nullptr, nullptr, nullptr, iv)) {
+        fprintf(stderr, "Could not reset audio cipher\n");
+        return -1;
+    }
+
+    int offset = cipher->adts ? adts_header_length(pkt->data, pkt->size) : 0;
+    int len = pkt->size - offset;
+    if (len <= 0) return 0;
+    int outLen = 0;
+    if (!EVP_EncryptUpdate(cipher->ctx, pkt->data + offset, &outLen, pkt->data + offset, len)) {
+        fprintf(stderr, "Error encrypting audio packet\n");
+        return -1;
+    }
+    return 0;
+}
+
+int write_audio_packet(AVFormatContext* inFmtCtx, AudioTrack* audio,
+                       AVFormatContext* outFmtCtx, AVPacket* pkt) {
+    if (audio->cipher) {
+        int ret = audio_cipher_apply(audio->cipher, pkt);
+        if (ret < 0) return ret;
+    }
+    av_packet_rescale_ts(pkt, inFmtCtx->streams[audio->inIndex]->time_base,
+                         audio->outStream->time_base);
+    pkt->stream_index = audio->outStream->index;
+    pkt->pos = -1;
+    int ret = av_interleaved_write_frame(outFmtCtx, pkt);
+    if (ret < 0)
+        fprintf(stderr, "Error writing audio packet\n");
+    return ret;
+}
@@ -0,0 +1,61 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+extern "C" {
+  #include <libavformat/avformat.h>
+  #include <libavcodec/avcodec.h>
+}
+
+// AES-256-CTR keystream applied to audio frame payloads. Opaque; see audio.cpp.
+struct AudioCipher;
+
+// Audio stream carried through the demux loop next to the video stream.
+// Packets are copied without decoding; if cipher is set their payloads are
+// encrypted in place before being written.
+struct AudioTrack {
+    int inIndex;
+    AVStream* outStream;
+    AudioCipher* cipher;
+};
+
+// Returns the index of the first audio stream in the input, or -1 if there is none.
+int find_audio_stream(AVFormatContext* inFmtCtx);
+
+// Adds a stream-copy output stream mirroring the given input audio stream.
+// Must be called before the output header is written.
+AVStream* add_audio_stream(AVFormatContext* inFmtCtx, int audioStreamIndex, AVFormatContext* outFmtCtx);
+
+// Container tag (format and stream metadata) holding the per-file audio nonce as
+// 16 hex digits. Containers that drop custom tags (e.g. MPEG-TS) get a sidecar
+// "<output>" AUDIO_NONCE_SIDECAR file instead.
+#define AUDIO_NONCE_TAG "audio_nonce"
+#define AUDIO_NONCE_SIDECAR ".audio_nonce"
+
+// Fills in track for the first input audio stream: adds its output stream and,
+// if seed is non-null, creates the cipher. Leaves track->outStream null (audio is
+// dropped with a warning) when there is no audio or the output container cannot
+// hold its codec. Encryption is only supported for AAC; other codecs carry frame
+// headers that demuxers re-parse, so they are refused with an error.
+// When encrypting, a random nonce is generated and stored with the output; when
+// decrypting it is read back from the input's tag or sidecar.
+// Returns 0 on success, negative on error.
+int setup_audio_track(AVFormatContext* inFmtCtx, AVFormatContext* outFmtCtx,
+                      const char* seed, bool decrypting, AudioTrack* track);
+
+// Creates the audio cipher. The AES-256 key is sha256 over a label for this
+// path, the seed and the per-file nonce, so no two files share a keystream and
+// none is shared with Scheme2. Each packet payload gets its own counter block,
+// nonce || (packet index << 32), so a packet decrypts independently of the ones
+// before it. adts says whether the stream's packets carry ADTS headers, which
+// stay in clear. CTR is symmetric: the same cipher decrypts.
+AudioCipher* audio_cipher_create(const char* seed, const unsigned char nonce[8], bool adts);
+void audio_cipher_free(AudioCipher** cipher);
+
+// Encrypts (or decrypts) the payload of the next audio packet in place.
+int audio_cipher_apply(AudioCipher* cipher, AVPacket* pkt);
+
+// Rescales, optionally encrypts, and writes one input audio packet to the output.
+int write_audio_packet(AVFormatContext* inFmtCtx, AudioTrack* audio,
+                       AVFormatContext* outFmtCtx, AVPacket* pkt);
+
+#endif // AUDIO_H
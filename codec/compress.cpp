@@ -1,6 +1,7 @@
 #include "compress.h"
 #include <cstdio>
 #include <cstdlib>
+#include <string>
 #include <libavutil/opt.h>
 
 int init_encoder(AVCodecContext *decCtx, const char *outFilename,
@@ -62,25 +63,22 @@ int init_encoder(AVCodecContext *decCtx, const char *outFilename,
         return ret;
     }
     (*outStream)->time_base = (*encCtx)->time_base;
-    if (!((*outFmtCtx)->oformat->flags & AVFMT_NOFILE))
-    {
-        ret = avio_open(&((*outFmtCtx)->pb), outFilename, AVIO_FLAG_WRITE);
-        if (ret < 0)
-        {
-            fprintf(stderr, "Could not open output file '%s'\n", outFilename);
-            return ret;
-        }
-    }
-    ret = avformat_write_header(*outFmtCtx, nullptr);
-    if (ret < 0)
-    {
-        fprintf(stderr, "Error writing header to output file\n");
-        return ret;
-    }
     return 0;
 }
 
 int encode_video(const char *input_filename, const char *output_filename)
+{
+    return encode_video_encrypt_audio(input_filename, output_filename, nullptr);
+}
+
+int encode_video_encrypt_audio(const char *input_filename, const char *output_filename,
+                               const char *audio_seed)
+{
+    return encode_video_controlled(input_filename, output_filename, audio_seed, nullptr);
+}
+
+int encode_video_controlled(const char *input_filename, const char *output_filename,
+                            const char *audio_seed, JobControl *control)
 {
     int videoStreamIndex = -1;
     AVFormatContext *inFmtCtx = nullptr;
@@ -88,6 +86,7 @@ int encode_video(const char *input_filename, const char *output_filename)
     AVCodecContext *decCtx = nullptr;
     AVCodecContext *encCtx = nullptr;
     AVStream *outStream = nullptr;
+    AudioTrack audio = {-1, nullptr, nullptr};
     int ret = 0;
 
     ret = open_input(input_filename, &inFmtCtx, &videoStreamIndex);
@@ -102,9 +101,19 @@ int encode_video(const char *input_filename, const char *output_filename)
     ret = init_encoder(decCtx, output_filename, &encCtx, &outFmtCtx, &outStream);
     if (ret < 0)
         goto end;
-    ret = process_frames(inFmtCtx, videoStreamIndex, decCtx, encCtx, outFmtCtx, outStream);
+    // Carry the audio stream through in the same demux loop; its frames are
+    // copied as-is, with only their payloads encrypted when a seed is given.
+    ret = setup_audio_track(inFmtCtx, outFmtCtx, audio_seed, false, &audio);
+    if (ret < 0)
+        goto end;
+    ret = open_output(outFmtCtx, output_filename);
+    if (ret < 0)
+        goto end;
+    ret = process_frames(inFmtCtx, videoStreamIndex, decCtx, encCtx, outFmtCtx, outStream,
+                         audio.outStream ? &audio : nullptr, control);
 
 end:
+    audio_cipher_free(&audio.cipher);
     if (decCtx)
         avcodec_free_context(&decCtx);
     if (encCtx)
@@ -117,5 +126,93 @@ end:
             avio_closep(&outFmtCtx->pb);
         avformat_free_context(outFmtCtx);
     }
+    // A cancelled job must not leave a truncated (but playable) file behind.
+    if (ret == JOB_CANCELLED)
+    {
+        remove(output_filename);
+        if (audio_seed)
+            remove((std::string(output_filename) + AUDIO_NONCE_SIDECAR).c_str());
+    }
+    return ret;
+}
+
+int decrypt_audio_remux(const char *input_filename, const char *output_filename,
+                        const char *audio_seed)
+{
+    int videoStreamIndex = -1;
+    AVFormatContext *inFmtCtx = nullptr;
+    AVFormatContext *outFmtCtx = nullptr;
+    AVStream *inStream = nullptr;
+    AVStream *outStream = nullptr;
+    AVPacket *pkt = nullptr;
+    AudioTrack audio = {-1, nullptr, nullptr};
+    int ret = 0;
+
+    ret = open_input(input_filename, &inFmtCtx, &videoStreamIndex);
+    if (ret < 0)
+        goto end;
+    if (avformat_alloc_output_context2(&outFmtCtx, nullptr, nullptr, output_filename) < 0)
+    {
+        fprintf(stderr, "Could not create output context\n");
+        ret = -1;
+        goto end;
+    }
+    // Video is stream-copied, so decrypting the audio costs no video quality.
+    inStream = inFmtCtx->streams[videoStreamIndex];
+    outStream = avformat_new_stream(outFmtCtx, nullptr);
+    if (!outStream || avcodec_parameters_copy(outStream->codecpar, inStream->codecpar) < 0)
+    {
+        fprintf(stderr, "Failed allocating output stream\n");
+        ret = -1;
+        goto end;
+    }
+    outStream->codecpar->codec_tag = 0;
+    outStream->time_base = inStream->time_base;
+    ret = setup_audio_track(inFmtCtx, outFmtCtx, audio_seed, true, &audio);
+    if (ret < 0)
+        goto end;
+    ret = open_output(outFmtCtx, output_filename);
+    if (ret < 0)
+        goto end;
+
+    pkt = av_packet_alloc();
+    if (!pkt)
+    {
+        fprintf(stderr, "Could not allocate packet\n");
+        ret = -1;
+        goto end;
+    }
+    while (av_read_frame(inFmtCtx, pkt) >= 0)
+    {
+        if (pkt->stream_index == videoStreamIndex)
+        {
+            av_packet_rescale_ts(pkt, inStream->time_base, outStream->time_base);
+            pkt->stream_index = outStream->index;
+            pkt->pos = -1;
+            ret = av_interleaved_write_frame(outFmtCtx, pkt);
+            if (ret < 0)
+                fprintf(stderr, "Error writing packet\n");
+        }
+        else if (audio.outStream && pkt->stream_index == audio.inIndex)
+        {
+            ret = write_audio_packet(inFmtCtx, &audio, outFmtCtx, pkt);
+        }
+        av_packet_unref(pkt);
+        if (ret < 0)
+            break;
+    }
+    av_write_trailer(outFmtCtx);
+
+end:
+    av_packet_free(&pkt);
+    audio_cipher_free(&audio.cipher);
+    if (inFmtCtx)
+        avformat_close_input(&inFmtCtx);
+    if (outFmtCtx)
+    {
+        if (!(outFmtCtx->oformat->flags & AVFMT_NOFILE))
+            avio_closep(&outFmtCtx->pb);
+        avformat_free_context(outFmtCtx);
+    }
     return ret;
 }
@@ -7,13 +7,35 @@
 extern "C" {
 #endif
 
-// Initializes the H.264 encoder for lossy compression.
+// Initializes the H.264 encoder for lossy compression and the output context with
+// its video stream. The header is written later by open_output().
 int init_encoder(AVCodecContext* decCtx, const char* outFilename,
                  AVCodecContext** encCtx, AVFormatContext** outFmtCtx, AVStream** outStream);
 
-// High-level function to encode (compress) a video.
+// High-level function to encode (compress) a video. Audio is copied unchanged, or
+// dropped with a warning if the output container cannot carry its codec.
 int encode_video(const char* input_filename, const char* output_filename);
 
+// Same as encode_video, but audio frame payloads are AES-CTR encrypted with a key
+// derived from audio_seed and a random per-file nonce (nullptr copies audio
+// unchanged). The nonce is stored in the output's audio_nonce tag, or in an
+// "<output>.audio_nonce" file for containers without custom tags (e.g. .ts).
+// Only AAC audio can be encrypted; other codecs fail with an error.
+int encode_video_encrypt_audio(const char* input_filename, const char* output_filename,
+                               const char* audio_seed);
+
+// Decrypts audio written by encode_video_encrypt_audio, reading its nonce back
+// from the input's tag or nonce file. Video packets are
+// stream-copied rather than re-encoded, so no further video quality is lost.
+int decrypt_audio_remux(const char* input_filename, const char* output_filename,
+                        const char* audio_seed);
+
+// Same as encode_video_encrypt_audio, with progress reporting and cooperative
+// cancellation through control (may be nullptr). Returns JOB_CANCELLED if cancelled,
+// in which case the partial output file is deleted.
+int encode_video_controlled(const char* input_filename, const char* output_filename,
+                            const char* audio_seed, JobControl* control);
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,18 +42,6 @@ int init_encoder_lossless(AVCodecContext* decCtx, const char* outFilename,
         return ret;
     }
     (*outStream)->time_base = (*encCtx)->time_base;
-    if (!((*outFmtCtx)->oformat->flags & AVFMT_NOFILE)) {
-        ret = avio_open(&((*outFmtCtx)->pb), outFilename, AVIO_FLAG_WRITE);
-        if (ret < 0) {
-            fprintf(stderr, "Could not open output file '%s'\n", outFilename);
-            return ret;
-        }
-    }
-    ret = avformat_write_header(*outFmtCtx, nullptr);
-    if (ret < 0) {
-        fprintf(stderr, "Error writing header to output file (lossless)\n");
-        return ret;
-    }
     return 0;
 }
 
@@ -72,6 +60,8 @@ int decode_video(const char* input_filename, const char* output_filename) {
     if (!decCtx) { ret = -1; goto end; }
     ret = init_encoder_lossless(decCtx, output_filename, &encCtx, &outFmtCtx, &outStream);
     if (ret < 0) goto end;
+    ret = open_output(outFmtCtx, output_filename);
+    if (ret < 0) goto end;
     ret = process_frames(inFmtCtx, videoStreamIndex, decCtx, encCtx, outFmtCtx, outStream);
 
 end:
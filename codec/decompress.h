@@ -7,7 +7,8 @@
 extern "C" {
 #endif
 
-// Initializes the H.264 encoder in lossless mode.
+// Initializes the H.264 encoder in lossless mode and the output context with its
+// video stream. The header is written later by open_output().
 int init_encoder_lossless(AVCodecContext* decCtx, const char* outFilename,
                           AVCodecContext** encCtx, AVFormatContext** outFmtCtx, AVStream** outStream);
 
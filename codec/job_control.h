@@ -0,0 +1,25 @@
+#ifndef JOB_CONTROL_H
+#define JOB_CONTROL_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+// Returned by a long-running call that stopped because its job was cancelled.
+// Kept distinct from AVERROR codes and the -1 used for ordinary failures.
+constexpr int JOB_CANCELLED = -0x43414e43; // 'CANC'
+
+// Cooperative control shared between a job and the loop doing its work.
+// Loops poll is_cancelled() once per packet/frame and report progress as they go;
+// totalFrames is 0 when the frame count is not known in advance.
+struct JobControl {
+    std::atomic<bool> cancelled{false};
+    std::function<void(int64_t framesDone, int64_t totalFrames)> onProgress;
+
+    bool is_cancelled() const { return cancelled.load(std::memory_order_relaxed); }
+    void report(int64_t framesDone, int64_t totalFrames) const {
+        if (onProgress) onProgress(framesDone, totalFrames);
+    }
+};
+
+#endif // JOB_CONTROL_H
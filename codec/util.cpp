@@ -44,9 +44,27 @@ AVCodecContext* init_decoder(AVFormatContext* inFmtCtx, int videoStreamIndex) {
     return decCtx;
 }
 
+int open_output(AVFormatContext* outFmtCtx, const char* outFilename) {
+    int ret;
+    if (!(outFmtCtx->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&outFmtCtx->pb, outFilename, AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            fprintf(stderr, "Could not open output file '%s'\n", outFilename);
+            return ret;
+        }
+    }
+    ret = avformat_write_header(outFmtCtx, nullptr);
+    if (ret < 0) {
+        fprintf(stderr, "Error writing header to output file\n");
+        return ret;
+    }
+    return 0;
+}
+
 int process_frames(AVFormatContext* inFmtCtx, int videoStreamIndex,
                    AVCodecContext* decCtx, AVCodecContext* encCtx,
-                   AVFormatContext* outFmtCtx, AVStream* outStream) {
+                   AVFormatContext* outFmtCtx, AVStream* outStream,
+                   AudioTrack* audio, JobControl* control) {
     AVPacket* inPkt = av_packet_alloc();
     AVFrame* frame = av_frame_alloc();
     AVFrame* frameConv = av_frame_alloc();
@@ -71,8 +89,22 @@ int process_frames(AVFormatContext* inFmtCtx, int videoStreamIndex,
     frameConv->height = encCtx->height;
     frameConv->format = encCtx->pix_fmt;
 
+    // Frame count for progress; estimated from duration and frame rate if the container lacks it.
+    AVStream* inStream = inFmtCtx->streams[videoStreamIndex];
+    int64_t totalFrames = inStream->nb_frames;
+    if (totalFrames <= 0 && inFmtCtx->duration > 0 && inStream->avg_frame_rate.den > 0)
+        totalFrames = av_rescale_q(inFmtCtx->duration, AV_TIME_BASE_Q, av_inv_q(inStream->avg_frame_rate));
+    int64_t framesDone = 0;
+    bool cancelled = false;
+    int err = 0;
+
     int ret;
     while (av_read_frame(inFmtCtx, inPkt) >= 0) {
+        if (control && control->is_cancelled()) {
+            av_packet_unref(inPkt);
+            cancelled = true;
+            break;
+        }
         if (inPkt->stream_index == videoStreamIndex) {
             ret = avcodec_send_packet(decCtx, inPkt);
             if (ret < 0) {
@@ -108,13 +140,23 @@ int process_frames(AVFormatContext* inFmtCtx, int videoStreamIndex,
                 av_packet_free(&encPkt);
                 av_frame_unref(frame);
                 av_frame_unref(frameConv);
+                if (control) control->report(++framesDone, totalFrames);
+            }
+        } else if (audio && inPkt->stream_index == audio->inIndex) {
+            ret = write_audio_packet(inFmtCtx, audio, outFmtCtx, inPkt);
+            if (ret < 0) {
+                // Stop rather than hand back a silently truncated file as success.
+                av_packet_unref(inPkt);
+                err = ret;
+                break;
             }
         }
         av_packet_unref(inPkt);
     }
-    // Flush encoder.
-    avcodec_send_frame(encCtx, nullptr);
-    while (avcodec_receive_packet(encCtx, inPkt) == 0) {
+    // Flush encoder. A cancelled job skips the flush but still closes the file cleanly.
+    if (!cancelled)
+        avcodec_send_frame(encCtx, nullptr);
+    while (!cancelled && avcodec_receive_packet(encCtx, inPkt) == 0) {
         av_packet_rescale_ts(inPkt, encCtx->time_base, outStream->time_base);
         inPkt->stream_index = outStream->index;
         av_interleaved_write_frame(outFmtCtx, inPkt);
@@ -126,5 +168,7 @@ int process_frames(AVFormatContext* inFmtCtx, int videoStreamIndex,
     av_frame_free(&frame);
     av_frame_free(&frameConv);
     av_packet_free(&inPkt);
-    return 0;
+    if (cancelled)
+        return JOB_CANCELLED;
+    return err;
 }
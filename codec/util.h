@@ -9,15 +9,27 @@ extern "C" {
   #include <libavutil/opt.h>
 }
 
+#include "audio.h"
+#include "job_control.h"
+
 // Opens the input file and finds the first video stream.
 int open_input(const char* filename, AVFormatContext** inFmtCtx, int* videoStreamIndex);
 
 // Initializes the decoder context for the given video stream.
 AVCodecContext* init_decoder(AVFormatContext* inFmtCtx, int videoStreamIndex);
 
+// Opens the output file (if the format needs one) and writes the container header.
+// Call once every output stream has been added.
+int open_output(AVFormatContext* outFmtCtx, const char* outFilename);
+
 // Processes frames: decodes from input, converts if needed, encodes, and writes to output.
+// If audio is given, its packets are copied (and encrypted if audio->cipher is set)
+// to the output in the same demux loop. If control is given, progress is reported
+// per encoded frame and cancellation is checked per packet; returns JOB_CANCELLED
+// if the job was cancelled, or the error if an audio packet could not be written.
 int process_frames(AVFormatContext* inFmtCtx, int videoStreamIndex,
                    AVCodecContext* decCtx, AVCodecContext* encCtx,
-                   AVFormatContext* outFmtCtx, AVStream* outStream);
+                   AVFormatContext* outFmtCtx, AVStream* outStream,
+                   AudioTrack* audio = nullptr, JobControl* control = nullptr);
 
 #endif // UTIL_H
@@ -3,13 +3,15 @@
 
 namespace Encryption {
 
-int encrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key, Scheme scheme) {
-    return Scheme1::encrypt(videoPath,outputPath,key);
+int encrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key, Scheme scheme,
+            JobControl *control) {
+    return Scheme1::encrypt(videoPath,outputPath,key,control);
     return 0;
 }
 
-int decrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key, Scheme scheme) {
-    return Scheme1::decrypt(videoPath,outputPath,key);
+int decrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key, Scheme scheme,
+            JobControl *control) {
+    return Scheme1::decrypt(videoPath,outputPath,key,control);
     return 0;
 }
 
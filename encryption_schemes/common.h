@@ -3,6 +3,7 @@
 
 #include <string>
 #include <opencv2/opencv.hpp>
+#include "job_control.h"
 
 // Enumerate available schemes.
 namespace Encryption {
@@ -12,9 +13,12 @@ namespace Encryption {
         // Add more schemes here as needed.
     };
 
-    // Encryption and decryption functions
-    int encrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key, Scheme scheme);
-    int decrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key, Scheme scheme);
+    // Encryption and decryption functions. control (optional) carries progress
+    // reporting and cancellation; a cancelled call returns JOB_CANCELLED.
+    int encrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key, Scheme scheme,
+                JobControl *control = nullptr);
+    int decrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key, Scheme scheme,
+                JobControl *control = nullptr);
 }
 
 #endif // ENCRYPTION_COMMON_H
\ No newline at end of file
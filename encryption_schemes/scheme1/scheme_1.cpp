@@ -5,8 +5,19 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <functional>
 #include <random>       // For std::mt19937
+#include <sstream>
+#include <thread>
 #include <vector>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
 
 namespace fs = std::filesystem;
 
@@ -107,6 +118,104 @@ cv::Mat decrypt_image(const cv::Mat &image, const std::string &key) {
     return decrypted;
 }
 
+std::vector<cv::Rect> RoiMap::regions(int frameIndex) const {
+    std::vector<cv::Rect> result = all;
+    auto it = frames.find(frameIndex);
+    if (it != frames.end())
+        result.insert(result.end(), it->second.begin(), it->second.end());
+    return result;
+}
+
+// Encrypt only the given regions of an image.
+cv::Mat encrypt_image_roi(const cv::Mat &image, const std::string &key, const std::vector<cv::Rect> &rois) {
+    cv::Mat encrypted = image.clone();
+    cv::Rect bounds(0, 0, encrypted.cols, encrypted.rows);
+    for (const cv::Rect &roi : rois) {
+        cv::Rect r = roi & bounds;
+        if (r.empty()) continue;
+        // Each region is treated as an image of its own: XOR and column swap stay inside it.
+        encrypt_image(encrypted(r), key).copyTo(encrypted(r));
+    }
+    return encrypted;
+}
+
+// Decrypt only the given regions of an image.
+cv::Mat decrypt_image_roi(const cv::Mat &image, const std::string &key, const std::vector<cv::Rect> &rois) {
+    cv::Mat decrypted = image.clone();
+    cv::Rect bounds(0, 0, decrypted.cols, decrypted.rows);
+    // Undo regions in reverse order so overlapping rectangles are restored correctly.
+    for (auto it = rois.rbegin(); it != rois.rend(); ++it) {
+        cv::Rect r = *it & bounds;
+        if (r.empty()) continue;
+        decrypt_image(decrypted(r), key).copyTo(decrypted(r));
+    }
+    return decrypted;
+}
+
+std::vector<cv::Rect> tile_mask_rois(cv::Size frameSize, int tileSize, const std::vector<uchar> &mask) {
+    std::vector<cv::Rect> rois;
+    if (tileSize <= 0) return rois;
+    int tilesX = (frameSize.width + tileSize - 1) / tileSize;
+    int tilesY = (frameSize.height + tileSize - 1) / tileSize;
+    cv::Rect bounds(0, 0, frameSize.width, frameSize.height);
+    for (int ty = 0; ty < tilesY; ty++) {
+        int tx = 0;
+        while (tx < tilesX) {
+            size_t idx = static_cast<size_t>(ty) * tilesX + tx;
+            if (idx >= mask.size() || !mask[idx]) { tx++; continue; }
+            // Merge the run of marked tiles so it is scrambled as one strip.
+            int start = tx;
+            while (tx < tilesX && idx < mask.size() && mask[idx]) { tx++; idx++; }
+            cv::Rect run(start * tileSize, ty * tileSize, (tx - start) * tileSize, tileSize);
+            rois.push_back(run & bounds);
+        }
+    }
+    return rois;
+}
+
+int load_rois(const std::string &path, RoiMap &rois) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Could not open ROI file " << path << std::endl;
+        return -1;
+    }
+    rois = RoiMap();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        int frame;
+        cv::Rect r;
+        if (!(fields >> frame >> r.x >> r.y >> r.width >> r.height)) {
+            std::cerr << "Malformed ROI line: " << line << std::endl;
+            return -1;
+        }
+        if (frame < 0) rois.all.push_back(r);
+        else rois.frames[frame].push_back(r);
+    }
+    return 0;
+}
+
+int save_rois(const std::string &path, const RoiMap &rois) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Could not write ROI file " << path << std::endl;
+        return -1;
+    }
+    out << "# frame x y w h (frame -1 = every frame)\n";
+    for (const cv::Rect &r : rois.all)
+        out << -1 << ' ' << r.x << ' ' << r.y << ' ' << r.width << ' ' << r.height << '\n';
+    for (const auto &entry : rois.frames)
+        for (const cv::Rect &r : entry.second)
+            out << entry.first << ' ' << r.x << ' ' << r.y << ' ' << r.width << ' ' << r.height << '\n';
+    out.close();
+    if (!out) {
+        std::cerr << "Could not write ROI file " << path << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
 #include <iostream>
 #include <string>
 #include <filesystem>
@@ -118,102 +227,195 @@ namespace fs = std::filesystem;
 cv::Mat encrypt_image(const cv::Mat& frame, const std::string& key);
 cv::Mat decrypt_image(const cv::Mat& frame, const std::string& key);
 
-// Encrypt ALL frames from the video and rebuild a new, fully encrypted video.
-int encrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key) {
-    // Create temporary directories.
-    fs::create_directory("temp_all_frames");
-    fs::create_directory("temp_encrypted_frames");
+// Private working directory under the system temp dir (mkdtemp, so unique across
+// processes too). Removed on every return path when it goes out of scope.
+struct TempDir {
+    fs::path path;
+    TempDir() {
+        std::error_code ec;
+        fs::path base = fs::temp_directory_path(ec);
+        std::string tmpl = ((ec ? fs::path("/tmp") : base) / "scheme1_XXXXXX").string();
+        if (mkdtemp(&tmpl[0])) path = tmpl;
+    }
+    ~TempDir() {
+        std::error_code ec;
+        if (!path.empty()) fs::remove_all(path, ec);
+    }
+};
+
+// Run a shell command. With a job control it runs in its own process group and is
+// polled, so a cancelled job kills ffmpeg instead of holding its worker until
+// ffmpeg exits. Returns 0 on success, -1 on failure, JOB_CANCELLED if cancelled.
+static int run_command(const std::string &cmd, JobControl *control) {
+    std::cout << "Executing: " << cmd << std::endl;
+    if (!control) return system(cmd.c_str()) == 0 ? 0 : -1;
+
+    std::string execCmd = "exec " + cmd;
+    const char *argv[] = {"sh", "-c", execCmd.c_str(), nullptr};
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attr, 0);
+    pid_t pid;
+    int err = posix_spawn(&pid, "/bin/sh", nullptr, &attr, const_cast<char *const *>(argv), environ);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0) return -1;
 
-    // --- Step 1: Extract ALL frames from the video ---
+    int status = 0;
+    for (;;) {
+        pid_t r = waitpid(pid, &status, WNOHANG);
+        if (r == pid) break;
+        if (r < 0 && errno != EINTR) return -1;
+        if (control->is_cancelled()) {
+            kill(-pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            return JOB_CANCELLED;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+// Number of extracted .png frames in a directory, for progress reporting.
+static int64_t count_frames(const std::string &dir) {
+    int64_t n = 0;
+    for (const auto &entry : fs::directory_iterator(dir))
+        if (entry.path().extension() == ".png") n++;
+    return n;
+}
+
+static int cancel_job() {
+    std::cerr << "Job cancelled." << std::endl;
+    return JOB_CANCELLED;
+}
+
+// Extract all frames, apply `transform` to each one (with its 0-based index), and rebuild the video.
+static int transform_frames(const std::string &videoPath, const std::string &outputPath,
+                            const std::function<cv::Mat(const cv::Mat &, int)> &transform,
+                            JobControl *control) {
+    TempDir tmp;
+    if (tmp.path.empty()) {
+        std::cerr << "Could not create temporary directory." << std::endl;
+        return -1;
+    }
+    const std::string inDir = (tmp.path / "in").string();
+    const std::string outDir = (tmp.path / "out").string();
+    fs::create_directory(inDir);
+    fs::create_directory(outDir);
+
+    // --- Step 1: Extract all frames ---
     // Note: It's good practice to get the original video's framerate for reassembly.
     // For simplicity here, we'll assume 25, but a robust solution would use ffprobe to get the actual rate.
-    // A placeholder framerate of 25 is used in the final command.
     {
-        std::string cmd = "ffmpeg -y -i " + videoPath + " temp_all_frames/frame_%04d.png";
-        std::cout << "Executing: " << cmd << std::endl;
-        if (system(cmd.c_str()) != 0) {
-            std::cerr << "Error extracting all frames." << std::endl;
+        std::string cmd = "ffmpeg -y -i " + videoPath + " " + inDir + "/frame_%04d.png";
+        int ret = run_command(cmd, control);
+        if (ret == JOB_CANCELLED) return cancel_job();
+        if (ret != 0) {
+            std::cerr << "Error extracting frames." << std::endl;
             return -1;
         }
     }
 
-    // --- Step 2: Encrypt each frame ---
-    for (const auto &entry : fs::directory_iterator("temp_all_frames")) {
+    if (control && control->is_cancelled()) return cancel_job();
+    int64_t totalFrames = count_frames(inDir);
+    int64_t framesDone = 0;
+
+    // --- Step 2: Transform each frame; the index comes from the frame number in the file name ---
+    for (const auto &entry : fs::directory_iterator(inDir)) {
+        if (control && control->is_cancelled()) return cancel_job();
         if (entry.path().extension() == ".png") {
             cv::Mat frame = cv::imread(entry.path().string(), cv::IMREAD_COLOR);
             if (frame.empty()) continue;
 
-            cv::Mat encFrame = encrypt_image(frame, key);
-            std::string outPath = "temp_encrypted_frames/" + entry.path().filename().string();
-            cv::imwrite(outPath, encFrame);
+            int index = std::stoi(entry.path().stem().string().substr(6)) - 1;
+            cv::Mat outFrame = transform(frame, index);
+            std::string outPath = outDir + "/" + entry.path().filename().string();
+            cv::imwrite(outPath, outFrame);
+            if (control) control->report(++framesDone, totalFrames);
         }
     }
 
-    // --- Step 3: Rebuild the video from encrypted frames, copying the original audio ---
+    if (control && control->is_cancelled()) return cancel_job();
+
+    // --- Step 3: Rebuild the video, copying the audio ---
     {
-        // This command creates a new video from the encrypted image sequence
-        // and copies the audio stream from the original video.
-        std::string cmd = "ffmpeg -y -framerate 25 -i temp_encrypted_frames/frame_%04d.png "
+        std::string cmd = "ffmpeg -y -framerate 25 -i " + outDir + "/frame_%04d.png "
                           "-i " + videoPath + " -map 0:v:0 -map 1:a:0? -c:a copy "
                           "-c:v libx264 -pix_fmt yuv420p " + outputPath;
-        std::cout << "Executing: " << cmd << std::endl;
-        if (system(cmd.c_str()) != 0) {
-            std::cerr << "Error rebuilding video from encrypted frames." << std::endl;
+        int ret = run_command(cmd, control);
+        if (ret == JOB_CANCELLED) {
+            // Don't leave a half-written video behind.
+            std::error_code ec;
+            fs::remove(outputPath, ec);
+            return cancel_job();
+        }
+        if (ret != 0) {
+            std::cerr << "Error rebuilding video from frames." << std::endl;
             return -1;
         }
     }
 
-    // --- Step 4: Cleanup temporary directories ---
-    fs::remove_all("temp_all_frames");
-    fs::remove_all("temp_encrypted_frames");
+    // The temporary directory is removed when tmp goes out of scope.
+    return 0;
+}
 
+// Encrypt ALL frames from the video and rebuild a new, fully encrypted video.
+int encrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key, JobControl *control) {
+    int ret = transform_frames(videoPath, outputPath, [&](const cv::Mat &frame, int) {
+        return encrypt_image(frame, key);
+    }, control);
+    if (ret != 0) return ret;
     std::cout << "Encrypted video saved to " << outputPath << std::endl;
     return 0;
 }
 
 // Decrypt ALL frames from the video and rebuild a new, decrypted video.
-int decrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key) {
-    fs::create_directory("temp_enc_frames");
-    fs::create_directory("temp_dec_frames");
+int decrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key, JobControl *control) {
+    int ret = transform_frames(videoPath, outputPath, [&](const cv::Mat &frame, int) {
+        return decrypt_image(frame, key);
+    }, control);
+    if (ret != 0) return ret;
+    std::cout << "Decrypted video saved to " << outputPath << std::endl;
+    return 0;
+}
 
-    // --- Step 1: Extract all frames from the encrypted video ---
-    {
-        std::string cmd = "ffmpeg -y -i " + videoPath + " temp_enc_frames/frame_%04d.png";
-        std::cout << "Executing: " << cmd << std::endl;
-        if (system(cmd.c_str()) != 0) {
-            std::cerr << "Error extracting encrypted frames." << std::endl;
-            return -1;
-        }
+// Encrypt only the regions of interest in each frame and store the ROI metadata next to the output.
+int encrypt_roi(const std::string &videoPath, const std::string &outputPath, const std::string &key, const RoiMap &rois,
+                JobControl *control) {
+    // The video cannot be decrypted without its ROI metadata, so write that first
+    // and never leave one without the other.
+    const std::string roiPath = outputPath + ".roi";
+    if (save_rois(roiPath, rois) != 0) {
+        std::cerr << "ROI metadata is required to decrypt the output; not encrypting " << videoPath << std::endl;
+        std::error_code ec;
+        fs::remove(roiPath, ec);
+        return -1;
     }
-
-    // --- Step 2: Decrypt each frame ---
-    for (const auto &entry : fs::directory_iterator("temp_enc_frames")) {
-        if (entry.path().extension() == ".png") {
-            cv::Mat encFrame = cv::imread(entry.path().string(), cv::IMREAD_COLOR);
-            if (encFrame.empty()) continue;
-
-            cv::Mat decFrame = decrypt_image(encFrame, key);
-            std::string outPath = "temp_dec_frames/" + entry.path().filename().string();
-            cv::imwrite(outPath, decFrame);
-        }
+    int ret = transform_frames(videoPath, outputPath, [&](const cv::Mat &frame, int index) {
+        return encrypt_image_roi(frame, key, rois.regions(index));
+    }, control);
+    if (ret != 0) {
+        std::error_code ec;
+        fs::remove(outputPath, ec);
+        fs::remove(roiPath, ec);
+        return ret;
     }
+    std::cout << "Encrypted video saved to " << outputPath << " (ROI metadata: " << outputPath << ".roi)" << std::endl;
+    return 0;
+}
 
-    // --- Step 3: Rebuild the video from decrypted frames, copying the audio ---
-    {
-        // We copy the audio from the encrypted video file.
-        std::string cmd = "ffmpeg -y -framerate 25 -i temp_dec_frames/frame_%04d.png "
-                          "-i " + videoPath + " -map 0:v:0 -map 1:a:0? -c:a copy "
-                          "-c:v libx264 -pix_fmt yuv420p " + outputPath;
-        std::cout << "Executing: " << cmd << std::endl;
-        if (system(cmd.c_str()) != 0) {
-            std::cerr << "Error rebuilding video from decrypted frames." << std::endl;
-            return -1;
-        }
+// Decrypt the regions of interest recorded in "<videoPath>.roi".
+int decrypt_roi(const std::string &videoPath, const std::string &outputPath, const std::string &key,
+                JobControl *control) {
+    RoiMap rois;
+    if (load_rois(videoPath + ".roi", rois) != 0) {
+        std::cerr << "ROI metadata " << videoPath << ".roi is required to decrypt " << videoPath << std::endl;
+        return -1;
     }
-
-    // --- Step 4: Cleanup ---
-    fs::remove_all("temp_enc_frames");
-    fs::remove_all("temp_dec_frames");
+    int ret = transform_frames(videoPath, outputPath, [&](const cv::Mat &frame, int index) {
+        return decrypt_image_roi(frame, key, rois.regions(index));
+    }, control);
+    if (ret != 0) return ret;
     std::cout << "Decrypted video saved to " << outputPath << std::endl;
     return 0;
 }
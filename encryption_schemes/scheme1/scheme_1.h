@@ -1,18 +1,57 @@
 #ifndef SCHEME1
 #define SCHEME1
 
+#include "job_control.h"
 #include <opencv2/opencv.hpp>
+#include <map>
 #include <string>
 #include <vector>
 
 namespace Scheme1 {
+    // Regions of interest for a video. Rectangles in `all` apply to every frame
+    // (e.g. a fixed tile mask); `frames` maps a 0-based frame index to extra
+    // rectangles for that frame only.
+    struct RoiMap {
+        std::vector<cv::Rect> all;
+        std::map<int, std::vector<cv::Rect>> frames;
+
+        std::vector<cv::Rect> regions(int frameIndex) const;
+    };
+
     // Encrypt and decrypt a single image.
     cv::Mat encrypt_image(const cv::Mat &image, const std::string &key);
     cv::Mat decrypt_image(const cv::Mat &image, const std::string &key);
 
-    // Public functions to process I-frames from a video.
-    int encrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key);
-    int decrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key);
+    // Encrypt and decrypt only the given regions of a single image; pixels outside
+    // them are copied unchanged. Decryption must be given the same list.
+    cv::Mat encrypt_image_roi(const cv::Mat &image, const std::string &key, const std::vector<cv::Rect> &rois);
+    cv::Mat decrypt_image_roi(const cv::Mat &image, const std::string &key, const std::vector<cv::Rect> &rois);
+
+    // Build rectangles from a row-major tile mask over a frame split into
+    // tileSize x tileSize tiles; a non-zero entry marks a tile for encryption.
+    // Adjacent marked tiles in a row are merged into one rectangle.
+    std::vector<cv::Rect> tile_mask_rois(cv::Size frameSize, int tileSize, const std::vector<uchar> &mask);
+
+    // Read and write ROI metadata. One rectangle per line: "<frame> <x> <y> <w> <h>",
+    // where frame -1 means every frame. Lines starting with '#' are ignored.
+    int load_rois(const std::string &path, RoiMap &rois);
+    int save_rois(const std::string &path, const RoiMap &rois);
+
+    // Public functions to process I-frames from a video. If control is given, progress
+    // is reported per frame and cancellation is checked between frames and steps;
+    // a cancelled call returns JOB_CANCELLED.
+    int encrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key,
+                JobControl *control = nullptr);
+    int decrypt(const std::string &videoPath, const std::string &outputPath, const std::string &key,
+                JobControl *control = nullptr);
+
+    // ROI variants: only the regions in `rois` are transformed. encrypt_roi writes
+    // the ROI metadata next to the output as "<outputPath>.roi" before the video and
+    // removes both if either fails; decrypt_roi requires it at "<videoPath>.roi".
+    int encrypt_roi(const std::string &videoPath, const std::string &outputPath, const std::string &key, const RoiMap &rois,
+                    JobControl *control = nullptr);
+    int decrypt_roi(const std::string &videoPath, const std::string &outputPath, const std::string &key,
+                    JobControl *control = nullptr);
 }
 
 #endif // SCHEME1
@@ -0,0 +1,168 @@
+#include "job_pool.h"
+#include <exception>
+#include <iostream>
+
+namespace Jobs {
+
+Job::Job(Work work, ProgressCallback onProgress)
+    : work_(std::move(work)), onProgress_(std::move(onProgress)) {
+    result_ = promise_.get_future().share();
+    control_.onProgress = [this](int64_t framesDone, int64_t totalFrames) {
+        on_frame(framesDone, totalFrames);
+    };
+}
+
+void Job::cancel() {
+    control_.cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool Job::cancelled() const {
+    return control_.is_cancelled();
+}
+
+Progress Job::progress() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return progress_;
+}
+
+int Job::wait() {
+    return result_.get();
+}
+
+std::shared_future<int> Job::result() const {
+    return result_;
+}
+
+void Job::on_frame(int64_t framesDone, int64_t totalFrames) {
+    // Throughput is averaged over the whole run so far, which keeps the ETA steady.
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    Progress p;
+    p.framesDone = framesDone;
+    p.totalFrames = totalFrames;
+    p.framesPerSecond = elapsed > 0 ? framesDone / elapsed : 0;
+    if (totalFrames > framesDone && p.framesPerSecond > 0)
+        p.etaSeconds = (totalFrames - framesDone) / p.framesPerSecond;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_ = p;
+    }
+    if (!onProgress_) return;
+    // The callback runs inside the media loops, which clean up through C-style
+    // gotos; an exception unwinding through them would leak FFmpeg contexts.
+    try {
+        onProgress_(p);
+    } catch (const std::exception &e) {
+        std::cerr << "Progress callback failed, cancelling job: " << e.what() << std::endl;
+        cancel();
+    } catch (...) {
+        std::cerr << "Progress callback failed, cancelling job: unknown exception" << std::endl;
+        cancel();
+    }
+}
+
+void Job::run() {
+    if (control_.is_cancelled()) {
+        promise_.set_value(JOB_CANCELLED);
+        return;
+    }
+    start_ = std::chrono::steady_clock::now();
+    int ret;
+    try {
+        ret = work_(control_);
+    } catch (const std::exception &e) {
+        std::cerr << "Job failed: " << e.what() << std::endl;
+        ret = -1;
+    } catch (...) {
+        std::cerr << "Job failed: unknown exception" << std::endl;
+        ret = -1;
+    }
+    promise_.set_value(ret);
+}
+
+JobPool::JobPool(size_t workers, size_t maxQueued) : maxQueued_(maxQueued) {
+    if (workers == 0) workers = 1;
+    // Jobs always pass through the queue, so a zero limit would block submit() forever.
+    if (maxQueued_ == 0) maxQueued_ = 1;
+    for (size_t i = 0; i < workers; i++)
+        workers_.emplace_back(&JobPool::worker_loop, this);
+}
+
+JobPool::~JobPool() {
+    std::deque<JobHandle> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        pending.swap(queue_);
+    }
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+    for (const JobHandle &job : pending) {
+        job->cancel();
+        job->run();
+    }
+    for (std::thread &t : workers_)
+        t.join();
+}
+
+JobHandle JobPool::submit(Work work, ProgressCallback onProgress) {
+    JobHandle job(new Job(std::move(work), std::move(onProgress)));
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return stopping_ || queue_.size() < maxQueued_; });
+        if (stopping_) {
+            lock.unlock();
+            job->cancel();
+            job->run();
+            return job;
+        }
+        queue_.push_back(job);
+    }
+    notEmpty_.notify_one();
+    return job;
+}
+
+JobHandle JobPool::try_submit(Work work, ProgressCallback onProgress) {
+    JobHandle job;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || queue_.size() >= maxQueued_)
+            return nullptr;
+        job.reset(new Job(std::move(work), std::move(onProgress)));
+        queue_.push_back(job);
+    }
+    notEmpty_.notify_one();
+    return job;
+}
+
+size_t JobPool::queued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+size_t JobPool::running() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+void JobPool::worker_loop() {
+    for (;;) {
+        JobHandle job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            notEmpty_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty())
+                return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            running_++;
+        }
+        notFull_.notify_one();
+        job->run();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_--;
+        }
+    }
+}
+
+} // namespace Jobs
@@ -0,0 +1,101 @@
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+#include "job_control.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Jobs {
+    // Progress snapshot of a job. totalFrames and etaSeconds are 0 when unknown.
+    struct Progress {
+        int64_t framesDone = 0;
+        int64_t totalFrames = 0;
+        double framesPerSecond = 0;
+        double etaSeconds = 0;
+    };
+
+    // Called on the worker thread each time the job reports a frame. If it throws,
+    // the exception is logged and the job is cancelled.
+    using ProgressCallback = std::function<void(const Progress &)>;
+
+    // The work a job runs. It should poll control.is_cancelled() and call
+    // control.report() as it goes; the return value becomes the job result.
+    using Work = std::function<int(JobControl &)>;
+
+    // Handle to a submitted job, shared between the caller and the pool.
+    class Job {
+    public:
+        // Request cooperative cancellation. A queued job never starts; a running
+        // one stops at its next check and finishes with JOB_CANCELLED.
+        void cancel();
+        bool cancelled() const;
+
+        Progress progress() const;
+
+        // Blocks until the job has finished and returns its result code.
+        int wait();
+        std::shared_future<int> result() const;
+
+    private:
+        friend class JobPool;
+        Job(Work work, ProgressCallback onProgress);
+        void run();
+        void on_frame(int64_t framesDone, int64_t totalFrames);
+
+        Work work_;
+        ProgressCallback onProgress_;
+        JobControl control_;
+        std::promise<int> promise_;
+        std::shared_future<int> result_;
+        mutable std::mutex mutex_;
+        Progress progress_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    using JobHandle = std::shared_ptr<Job>;
+
+    // Fixed set of worker threads running jobs from a bounded FIFO queue.
+    // At most `workers` jobs run at once; up to `maxQueued` more wait in line.
+    // Both limits are clamped to at least 1.
+    // When the queue is full submit() blocks and try_submit() fails, so overload
+    // is queued at the caller instead of oversubscribing the machine.
+    class JobPool {
+    public:
+        JobPool(size_t workers, size_t maxQueued);
+        // Cancels jobs still in the queue, waits for running jobs, joins workers.
+        ~JobPool();
+
+        JobPool(const JobPool &) = delete;
+        JobPool &operator=(const JobPool &) = delete;
+
+        JobHandle submit(Work work, ProgressCallback onProgress = nullptr);
+        // Returns nullptr instead of blocking when the queue is full.
+        JobHandle try_submit(Work work, ProgressCallback onProgress = nullptr);
+
+        size_t queued() const;
+        size_t running() const;
+
+    private:
+        void worker_loop();
+
+        std::vector<std::thread> workers_;
+        std::deque<JobHandle> queue_;
+        size_t maxQueued_;
+        size_t running_ = 0;
+        bool stopping_ = false;
+        mutable std::mutex mutex_;
+        std::condition_variable notEmpty_;
+        std::condition_variable notFull_;
+    };
+}
+
+#endif // JOB_POOL_H
@@ -0,0 +1,29 @@
+#include "media_jobs.h"
+#include "compress.h"
+
+namespace Jobs {
+
+JobHandle submit_encode(JobPool &pool, const std::string &inputPath, const std::string &outputPath,
+                        ProgressCallback onProgress) {
+    return pool.submit([=](JobControl &control) {
+        return encode_video_controlled(inputPath.c_str(), outputPath.c_str(), nullptr, &control);
+    }, std::move(onProgress));
+}
+
+JobHandle submit_encrypt(JobPool &pool, const std::string &videoPath, const std::string &outputPath,
+                         const std::string &key, Encryption::Scheme scheme,
+                         ProgressCallback onProgress) {
+    return pool.submit([=](JobControl &control) {
+        return Encryption::encrypt(videoPath, outputPath, key, scheme, &control);
+    }, std::move(onProgress));
+}
+
+JobHandle submit_decrypt(JobPool &pool, const std::string &videoPath, const std::string &outputPath,
+                         const std::string &key, Encryption::Scheme scheme,
+                         ProgressCallback onProgress) {
+    return pool.submit([=](JobControl &control) {
+        return Encryption::decrypt(videoPath, outputPath, key, scheme, &control);
+    }, std::move(onProgress));
+}
+
+} // namespace Jobs
@@ -0,0 +1,21 @@
+#ifndef MEDIA_JOBS_H
+#define MEDIA_JOBS_H
+
+#include "job_pool.h"
+#include "encryption_schemes/common.h"
+#include <string>
+
+namespace Jobs {
+    // Library entry points as pool jobs. Each blocks only while the pool queue is
+    // full; the returned handle gives progress, cancellation and the result code.
+    JobHandle submit_encode(JobPool &pool, const std::string &inputPath, const std::string &outputPath,
+                            ProgressCallback onProgress = nullptr);
+    JobHandle submit_encrypt(JobPool &pool, const std::string &videoPath, const std::string &outputPath,
+                             const std::string &key, Encryption::Scheme scheme,
+                             ProgressCallback onProgress = nullptr);
+    JobHandle submit_decrypt(JobPool &pool, const std::string &videoPath, const std::string &outputPath,
+                             const std::string &key, Encryption::Scheme scheme,
+                             ProgressCallback onProgress = nullptr);
+}
+
+#endif // MEDIA_JOBS_H